@@ -25,9 +25,24 @@ struct Harmonogram {
 #define MAX_HARMONOGRAM 30
 Harmonogram harmonogram[MAX_HARMONOGRAM]; // Tablica przechowująca harmonogram
 
+// Pojedyncze dzwonienie w indeksie (posortowane wg minuty dnia)
+struct Dzwonienie {
+  int minutaDnia;       // Minuta od północy (godzina * 60 + minuta)
+  int czasDzwonienia;   // Czas trwania dzwonienia w sekundach
+};
+
+// Posortowany indeks aktywnych dzwonień, odbudowywany po każdej zmianie harmonogramu
+Dzwonienie indeksDzwonien[MAX_HARMONOGRAM];
+int liczbaDzwonien = 0;
+
+// Limity zapytań o harmonogram
+#define MAX_NASTEPNE 50   // Maksymalna liczba zwracanych najbliższych dzwonień
+#define MAX_DNI_PODGLADU 31 // Maksymalna długość zakresu dat w podglądzie
+
 // Zmienne globalne do zarządzania stanem dzwonka
 bool dzwonekAktywny = false;              // Czy dzwonek jest aktualnie aktywny
 unsigned long czasAktywacji = 0;          // Czas rozpoczęcia aktywacji dzwonka
+int czasDzwonieniaAktywnego = 0;          // Czas trwania bieżącego dzwonienia w sekundach
 
 // Obiekty globalne
 RTC_DS3231 rtc;                           // Obiekt do obsługi zegara RTC
@@ -37,6 +52,38 @@ float temperaturaRTC = 0;                 // Temperatura odczytana z RTC
 int liczbaAktywacji = 0;                  // Licznik aktywacji dzwonka
 Preferences preferences;                  // Obiekt do obsługi pamięci nieulotnej
 
+// Funkcja budująca posortowany indeks aktywnych dzwonień
+void zbudujIndeksDzwonien() {
+  liczbaDzwonien = 0;
+  for (int i = 0; i < MAX_HARMONOGRAM; i++) {
+    if (!harmonogram[i].aktywny) continue;
+    // Pomiń wpisy spoza zakresu doby - sprawdzHarmonogram() nigdy ich nie uruchomi
+    if (harmonogram[i].godzina < 0 || harmonogram[i].godzina > 23 ||
+        harmonogram[i].minuta < 0 || harmonogram[i].minuta > 59) continue;
+    Dzwonienie d = {harmonogram[i].godzina * 60 + harmonogram[i].minuta, harmonogram[i].czasDzwonienia};
+
+    // Sortowanie przez wstawianie - przy równych minutach zostaje pierwszy wpis,
+    // bo tylko on faktycznie uruchomi dzwonek w sprawdzHarmonogram()
+    int j = liczbaDzwonien;
+    while (j > 0 && indeksDzwonien[j - 1].minutaDnia > d.minutaDnia) j--;
+    if (j > 0 && indeksDzwonien[j - 1].minutaDnia == d.minutaDnia) continue;
+    for (int k = liczbaDzwonien; k > j; k--) indeksDzwonien[k] = indeksDzwonien[k - 1];
+    indeksDzwonien[j] = d;
+    liczbaDzwonien++;
+  }
+}
+
+// Funkcja zwracająca pozycję pierwszego dzwonienia o minucie dnia >= minutaDnia (wyszukiwanie binarne)
+int znajdzDzwonienie(int minutaDnia) {
+  int lewo = 0, prawo = liczbaDzwonien;
+  while (lewo < prawo) {
+    int srodek = (lewo + prawo) / 2;
+    if (indeksDzwonien[srodek].minutaDnia < minutaDnia) lewo = srodek + 1;
+    else prawo = srodek;
+  }
+  return lewo;
+}
+
 // Funkcja wczytująca harmonogram z pamięci nieulotnej
 void wczytajHarmonogram() {
   preferences.begin("harmonogram", false);  // Otwórz przestrzeń nazw w pamięci
@@ -55,6 +102,7 @@ void wczytajHarmonogram() {
     }
   }
   preferences.end();  // Zamknij przestrzeń nazw
+  zbudujIndeksDzwonien(); // Odbuduj indeks dzwonień
 }
 
 // Funkcja zapisująca harmonogram do pamięci nieulotnej
@@ -65,6 +113,7 @@ void zapiszHarmonogram() {
     preferences.putBytes(key.c_str(), &harmonogram[i], sizeof(Harmonogram));
   }
   preferences.end();  // Zamknij przestrzeń nazw
+  zbudujIndeksDzwonien(); // Odbuduj indeks dzwonień
   Serial.println("Harmonogram zapisany"); // Informacja o zapisaniu harmonogramu
 }
 
@@ -80,6 +129,32 @@ String formatujDate(DateTime teraz) {
   return String(buf);
 }
 
+String formatujDateISO(DateTime dzien) {
+  char buf[20];
+  sprintf(buf, "%04d-%02d-%02d", dzien.year(), dzien.month(), dzien.day());
+  return String(buf);
+}
+
+// Funkcja parsująca datę w formacie RRRR-MM-DD
+bool parsujDate(String tekst, DateTime &wynik) {
+  int rok, miesiac, dzien;
+  if (sscanf(tekst.c_str(), "%d-%d-%d", &rok, &miesiac, &dzien) != 3) return false;
+  if (rok < 2000 || rok > 2099 || miesiac < 1 || miesiac > 12 || dzien < 1 || dzien > 31) return false;
+  wynik = DateTime(rok, miesiac, dzien, 0, 0, 0);
+  return wynik.isValid();
+}
+
+// Funkcja dopisująca pojedyncze dzwonienie do listy elementów tablicy JSON (bez nawiasów)
+void dopiszDzwonienie(String &json, DateTime dzien, const Dzwonienie &d) {
+  if (json.length() > 0) json += ","; // Dodaj przecinek między wpisami
+  json += "{";
+  json += "\"data\":\"" + formatujDateISO(dzien) + "\",";
+  json += "\"godzina\":" + String(d.minutaDnia / 60) + ",";
+  json += "\"minuta\":" + String(d.minutaDnia % 60) + ",";
+  json += "\"czasDzwonienia\":" + String(d.czasDzwonienia);
+  json += "}";
+}
+
 String formatujCzasPracy() {
   long czas = (millis() - startCzas) / 1000;
   int godz = czas / 3600;
@@ -95,6 +170,7 @@ void aktywujDzwonek(int czas) {
   digitalWrite(DZWONEK_PIN, HIGH); // Włącz dzwonek
   dzwonekAktywny = true;           // Ustaw flagę aktywności
   czasAktywacji = millis();        // Zapisz czas aktywacji
+  czasDzwonieniaAktywnego = czas;  // Zapisz żądany czas dzwonienia
   liczbaAktywacji++;               // Zwiększ licznik aktywacji
   
   Serial.println("Dzwonek aktywny na " + String(czas) + "s");
@@ -107,7 +183,7 @@ void sprawdzCzasDzwonka() {
     unsigned long aktualnyCzas = millis();
     unsigned long czasTrwania = aktualnyCzas - czasAktywacji;
     
-    if (czasTrwania >= (harmonogram[0].czasDzwonienia * 1000)) {
+    if (czasTrwania >= (unsigned long)czasDzwonieniaAktywnego * 1000) {
       digitalWrite(DZWONEK_PIN, LOW); // Wyłącz dzwonek
       dzwonekAktywny = false;         // Zresetuj flagę aktywności
       Serial.println("Dzwonek wylaczony po: " + String(czasTrwania) + "ms");
@@ -279,6 +355,7 @@ void handleGlowna() {
             <div class="panel-header">Status</div>
             <span class="status-indicator )=====" + (dzwonekAktywny ? "status-on" : "status-off") + R"=====(" id="statusDzwonka"></span>
             <span id="tekstStatusu">)=====" + (dzwonekAktywny ? "Dzwoni" : "Wylaczony") + R"=====(</span>
+            <div>Nastepny: <span id="nastepnyDzwonek">-</span></div>
             <button onclick="testujDzwonek()">Testuj dzwonek</button>
           </div>
         </div>
@@ -342,7 +419,18 @@ void handleGlowna() {
     }
     setInterval(aktualizujCzas, 500);
 
+    function wczytajNastepny() {
+      fetch('/nastepne?n=1')
+        .then(r => r.json())
+        .then(d => {
+          document.getElementById('nastepnyDzwonek').innerText = d.length ?
+            `${d[0].data} ${d[0].godzina.toString().padStart(2,'0')}:${d[0].minuta.toString().padStart(2,'0')} (${d[0].czasDzwonienia}s)` : '-';
+        });
+    }
+    setInterval(wczytajNastepny, 30000);
+
     function wczytajHarmonogram() {
+      wczytajNastepny();
       fetch('/pobierzharmonogram')
         .then(r => r.json())
         .then(d => {
@@ -452,6 +540,7 @@ void handleGlowna() {
         if(r.ok) {
           alert('Czas ustawiony!');
           aktualizujCzas();
+          wczytajNastepny();
         } else {
           alert('Blad!');
         }
@@ -568,6 +657,74 @@ void handlePobierzHarmonogram() {
   server.send(200, "application/json", json); // Wyślij dane w formacie JSON
 }
 
+// Funkcja obsługująca żądanie pobrania najbliższych dzwonień (parametr n)
+void handleNastepne() {
+  int n = server.hasArg("n") ? server.arg("n").toInt() : 1;
+  if (n < 1 || n > MAX_NASTEPNE) {
+    server.send(400, "text/plain", "Nieprawidłowe n"); // Błąd parametru
+    return;
+  }
+
+  DateTime teraz = rtc.now(); // Pobierz aktualny czas z RTC
+  DateTime dzien(teraz.year(), teraz.month(), teraz.day(), 0, 0, 0);
+
+  String json = "";
+  if (liczbaDzwonien > 0) {
+    // Dzwonienie w bieżącej minucie już nastąpiło (uruchamiane w sekundzie 0)
+    int poz = znajdzDzwonienie(teraz.hour() * 60 + teraz.minute() + 1);
+    for (int i = 0; i < n; i++) {
+      if (poz == liczbaDzwonien) { // Przejście na kolejny dzień
+        poz = 0;
+        dzien = dzien + TimeSpan(1, 0, 0, 0);
+      }
+      dopiszDzwonienie(json, dzien, indeksDzwonien[poz++]);
+    }
+  }
+
+  server.send(200, "application/json", "[" + json + "]"); // Wyślij dane w formacie JSON
+}
+
+// Funkcja obsługująca podgląd dzwonień w zakresie dat (parametry od, do w formacie RRRR-MM-DD)
+void handlePodglad() {
+  DateTime teraz = rtc.now(); // Pobierz aktualny czas z RTC
+  DateTime od(teraz.year(), teraz.month(), teraz.day(), 0, 0, 0);
+  DateTime doDnia = od;
+
+  if (server.hasArg("od") && !parsujDate(server.arg("od"), od)) {
+    server.send(400, "text/plain", "Nieprawidłowa data od"); // Błąd parametru
+    return;
+  }
+  if (!server.hasArg("do")) {
+    doDnia = od; // Domyślnie podgląd jednego dnia
+  } else if (!parsujDate(server.arg("do"), doDnia)) {
+    server.send(400, "text/plain", "Nieprawidłowa data do"); // Błąd parametru
+    return;
+  }
+
+  long liczbaDni = (doDnia - od).days() + 1;
+  if (liczbaDni < 1 || liczbaDni > MAX_DNI_PODGLADU) {
+    server.send(400, "text/plain", "Nieprawidłowy zakres dat"); // Błąd zakresu
+    return;
+  }
+
+  // Odpowiedź wysyłana porcjami (jeden dzień na porcję), żeby nie budować całego zakresu w RAM
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  server.sendContent("[");
+  DateTime dzien = od;
+  for (long d = 0; d < liczbaDni && liczbaDzwonien > 0; d++) {
+    String json = "";
+    for (int i = 0; i < liczbaDzwonien; i++) {
+      dopiszDzwonienie(json, dzien, indeksDzwonien[i]);
+    }
+    if (d > 0) server.sendContent(","); // Przecinek między porcjami dni
+    server.sendContent(json);
+    dzien = dzien + TimeSpan(1, 0, 0, 0);
+  }
+  server.sendContent("]");
+  server.sendContent(""); // Zakończ transmisję porcjami
+}
+
 // Funkcja obsługująca ustawienie czasu RTC
 void handleUstawCzas() {
   if (server.method() == HTTP_POST) { // Obsługiwane tylko żądania POST
@@ -659,6 +816,8 @@ void setup() {
   server.on("/ustawczas", HTTP_POST, handleUstawCzas);
   server.on("/diagnostyka", handleDiagnostyka);
   server.on("/dodaj", HTTP_POST, handleDodajPozycje);
+  server.on("/nastepne", handleNastepne);
+  server.on("/podglad", handlePodglad);
   server.begin(); // Uruchom serwer HTTP
 }
 